@@ -45,24 +45,90 @@ static char *cloneFirstWord(char *str)
     return word;
 }
 
+static void addRedirection(cmdLine *pCmdLine, int fd, char *path, int dupFd, char append)
+{
+    redirection *r;
+
+    if (pCmdLine->redirectCount == MAX_REDIRECTS) {
+        FREE(path);
+        return;
+    }
+
+    r = &pCmdLine->redirects[pCmdLine->redirectCount++];
+    r->fd = fd;
+    r->path = path;
+    r->dupFd = dupFd;
+    r->append = append;
+
+    if (path && fd == 0)
+        pCmdLine->inputRedirect = path;
+    else if (path && fd == 1)
+        pCmdLine->outputRedirect = path;
+}
+
 static void extractRedirections(char *strLine, cmdLine *pCmdLine)
 {
     char *s = strLine;
+    char *target;
+    char prefix, append;
+    int fd, dupFd;
 
     while ( (s = strpbrk(s,"<>")) ) {
         if (*s == '<') {
-            FREE(pCmdLine->inputRedirect);
-            pCmdLine->inputRedirect = cloneFirstWord(s+1);
-        }
-        else {
-            FREE(pCmdLine->outputRedirect);
-            pCmdLine->outputRedirect = cloneFirstWord(s+1);
+            if ( (target = cloneFirstWord(s+1)) )
+                addRedirection(pCmdLine, 0, target, -1, 0);
+            *s++ = 0;
+            continue;
         }
 
+        /* "N>" only when the digit stands alone, "&>" redirects both streams */
+        prefix = 0;
+        if (s > strLine && isdigit(s[-1]) && (s-1 == strLine || isspace(s[-2])))
+            prefix = s[-1];
+        else if (s > strLine && s[-1] == '&')
+            prefix = '&';
+        if (prefix)
+            s[-1] = 0;
+
+        append = (s[1] == '>');
         *s++ = 0;
+        if (append)
+            *s++ = 0;
+
+        fd = isdigit(prefix) ? prefix - '0' : 1;
+
+        /* "N>&M" makes fd N a copy of fd M, anything but a single digit after '&' is kept as dupFd -1 and rejected when applied */
+        if (prefix != '&' && !append && s[0] == '&') {
+            dupFd = -1;
+            if (isdigit(s[1]) && (s[2] == 0 || isspace(s[2]) || s[2] == '<' || s[2] == '>'))
+                dupFd = s[1] - '0';
+            addRedirection(pCmdLine, fd, NULL, dupFd, 0);
+            *s++ = 0;
+            while (*s && !isspace(*s) && *s != '<' && *s != '>')
+                *s++ = 0;
+            continue;
+        }
+
+        if (!(target = cloneFirstWord(s)))
+            continue;
+        addRedirection(pCmdLine, fd, target, -1, append);
+        if (prefix == '&')
+            addRedirection(pCmdLine, 2, NULL, 1, 0);
     }
 }
 
+/* Finds the '&' marking a non-blocking command, skipping the ones in "&>" and "2>&1" */
+static char *findAmpersand(char *line)
+{
+    char *s;
+
+    for (s = line; (s = strchr(s, '&')); s++)
+        if (s[1] != '>' && (s == line || s[-1] != '>'))
+            return s;
+
+    return NULL;
+}
+
 static char *strClone(const char *source)
 {
     char* clone = (char*)malloc(strlen(source) + 1);
@@ -143,7 +209,7 @@ cmdLine* parseCmdLines(const char *strLine)
 	if (line[strlen(line)-1] == '\n')
 	  line[strlen(line)-1] = 0;
 	
-	ampersand = strchr( line,  '&');
+	ampersand = findAmpersand(line);
 	if (ampersand)
 	  *(ampersand) = 0;
 		
@@ -168,8 +234,8 @@ void freeCmdLines(cmdLine *pCmdLine)
   if (!pCmdLine)
     return;
 
-  FREE(pCmdLine->inputRedirect);
-  FREE(pCmdLine->outputRedirect);
+  for (i=0; i<pCmdLine->redirectCount; ++i)
+      FREE(pCmdLine->redirects[i].path);
   for (i=0; i<pCmdLine->argCount; ++i)
       FREE(pCmdLine->arguments[i]);
 
@@ -1,11 +1,22 @@
 #define MAX_ARGUMENTS 256
+#define MAX_REDIRECTS 16
+
+typedef struct redirection
+{
+    int fd;                 /* descriptor being redirected (0 for '<', 1 for '>', 2 for '2>') */
+    char const *path;       /* file opened onto fd. NULL when fd is a copy of dupFd instead (N>&M) */
+    int dupFd;              /* descriptor copied onto fd when path is NULL, -1 when the N>&M target was not a digit */
+    char append;            /* boolean indicating '>>' (append) instead of '>' */
+} redirection;
 
 typedef struct cmdLine
 {
     char * const arguments[MAX_ARGUMENTS]; /* command line arguments (arg 0 is the command)*/
     int argCount;		/* number of arguments */
-    char const *inputRedirect;	/* input redirection path. NULL if no input redirection */
-    char const *outputRedirect;	/* output redirection path. NULL if no output redirection */
+    char const *inputRedirect;	/* input redirection path (last '<'). NULL if no input redirection. Points into redirects */
+    char const *outputRedirect;	/* output redirection path (last '>'). NULL if no output redirection. Points into redirects */
+    redirection redirects[MAX_REDIRECTS];	/* all redirections, to be applied in the order they were written */
+    int redirectCount;	/* number of redirections (the ones after the first MAX_REDIRECTS are dropped) */
     char blocking;	/* boolean indicating blocking/non-blocking */
     int idx;				/* index of current command in the chain of cmdLines (0 for the first) */
     struct cmdLine *next;	/* next cmdLine in chain */
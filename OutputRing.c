@@ -0,0 +1,96 @@
+#define _GNU_SOURCE // memfd_create, pipe2
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "OutputRing.h"
+
+/* Maps a memfd of size bytes twice in a row, so the ring never has to be split when read or written */
+static char *mapTwice(size_t size)
+{
+    char *base;
+    int fd = memfd_create("job-output", MFD_CLOEXEC);
+    if (fd == -1)
+        return NULL;
+
+    base = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ftruncate(fd, size) == -1 || base == MAP_FAILED ||
+        mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        int saved = errno;
+        if (base != MAP_FAILED)
+            munmap(base, 2 * size);
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+
+    close(fd); /* the mappings keep the memory alive */
+    return base;
+}
+
+int openRing(outputRing *ring, size_t cap, int *writeFd)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    int pipefd[2];
+
+    memset(ring, 0, sizeof(*ring));
+    ring->readFd = -1;
+    ring->size = cap < page ? page : (cap + page - 1) / page * page;
+    ring->base = mapTwice(ring->size);
+    if (ring->base == NULL)
+        return -1;
+
+    if (pipe2(pipefd, O_CLOEXEC) == -1) {
+        closeRing(ring);
+        return -1;
+    }
+
+    /* only the shell's end is non-blocking, the job keeps ordinary blocking writes */
+    fcntl(pipefd[0], F_SETFL, fcntl(pipefd[0], F_GETFL) | O_NONBLOCK);
+    ring->readFd = pipefd[0];
+    *writeFd = pipefd[1];
+    return 0;
+}
+
+int drainRing(outputRing *ring)
+{
+    ssize_t n;
+
+    if (ring->readFd == -1)
+        return 1;
+
+    /* reads land straight in the ring, wrapping through the second mapping */
+    while ((n = read(ring->readFd, ring->base + ring->total % ring->size, ring->size)) > 0)
+        ring->total += n;
+
+    if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+        close(ring->readFd);
+        ring->readFd = -1;
+        return 1;
+    }
+    return 0;
+}
+
+void writeRing(const outputRing *ring, int fd)
+{
+    size_t kept = ring->total < ring->size ? (size_t)ring->total : ring->size;
+    const char *start = ring->base + (ring->total - kept) % ring->size;
+    ssize_t n;
+
+    while (kept > 0 && (n = write(fd, start, kept)) > 0) {
+        start += n;
+        kept -= n;
+    }
+}
+
+void closeRing(outputRing *ring)
+{
+    if (ring->readFd != -1)
+        close(ring->readFd);
+    if (ring->base != NULL)
+        munmap(ring->base, 2 * ring->size);
+    ring->readFd = -1;
+    ring->base = NULL;
+}
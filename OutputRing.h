@@ -0,0 +1,24 @@
+#include <stddef.h>
+
+typedef struct outputRing
+{
+    char *base;                 /* the memfd mapped twice back to back, so any size bytes from any offset are contiguous */
+    size_t size;                /* capacity in bytes (a multiple of the page size); older output is overwritten */
+    unsigned long long total;   /* bytes produced so far, including the overwritten ones */
+    int readFd;                 /* non-blocking read end of the job's output pipe, -1 after end of file */
+} outputRing;
+
+/* Creates a ring of at least cap bytes and the pipe feeding it */
+/* The write end (close-on-exec) is returned in writeFd, to be dup'ed onto the job's stdout/stderr */
+/* Returns 0 on success, -1 on error (errno is set) */
+int openRing(outputRing *ring, size_t cap, int *writeFd);
+
+/* Moves whatever the pipe holds into the ring without blocking */
+/* Returns 1 once the job closed its end (readFd is closed and set to -1), 0 otherwise */
+int drainRing(outputRing *ring);
+
+/* Writes the retained output (at most size bytes, oldest first) to fd */
+void writeRing(const outputRing *ring, int fd);
+
+/* Releases the pipe and the memory of the ring */
+void closeRing(outputRing *ring);
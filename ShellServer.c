@@ -0,0 +1,140 @@
+#define _GNU_SOURCE // SOCK_CLOEXEC, MSG_CMSG_CLOEXEC
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "ShellServer.h"
+
+/* SOCK_SEQPACKET keeps every command line and reply in a single message */
+static int unixSocket(const char *path, struct sockaddr_un *addr)
+{
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+
+    return socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+}
+
+int listenOn(const char *path)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    int sock = unixSocket(path, &addr);
+    if (sock == -1)
+        return -1;
+
+    /* only a stale socket may be replaced, never some other file */
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            close(sock);
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(sock, SOMAXCONN) == -1) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int connectTo(const char *path)
+{
+    struct sockaddr_un addr;
+    int sock = unixSocket(path, &addr);
+    if (sock == -1)
+        return -1;
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int sendCommand(int sock, const char *commandLine, const int fds[SERVER_FDS])
+{
+    char control[CMSG_SPACE(sizeof(int) * SERVER_FDS)];
+    struct iovec iov = { (void *)commandLine, strlen(commandLine) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * SERVER_FDS);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * SERVER_FDS);
+
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == -1 ? -1 : 0;
+}
+
+int receiveCommand(int sock, char *commandLine, int size, int fds[SERVER_FDS])
+{
+    char control[CMSG_SPACE(sizeof(int) * SERVER_FDS)];
+    struct iovec iov = { commandLine, size - 1 };
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    ssize_t len;
+    int i, received = 0;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    len = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (len <= 0)
+        return (int)len;
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int) * SERVER_FDS)) {
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * SERVER_FDS);
+            received = 1;
+        }
+    }
+
+    if (!received || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        if (received)
+            for (i = 0; i < SERVER_FDS; i++)
+                close(fds[i]);
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    commandLine[len] = 0;
+    return 1;
+}
+
+int sendReply(int sock, const serverReply *reply)
+{
+    return send(sock, reply, sizeof(*reply), MSG_NOSIGNAL) == sizeof(*reply) ? 0 : -1;
+}
+
+int receiveReply(int sock, serverReply *reply)
+{
+    ssize_t len = recv(sock, reply, sizeof(*reply), 0);
+    if (len != sizeof(*reply)) {
+        if (len >= 0)
+            errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
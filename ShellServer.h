@@ -0,0 +1,31 @@
+#include <sys/resource.h>
+
+#define SERVER_MAX_COMMAND 2048
+#define SERVER_FDS 3
+
+typedef struct serverReply
+{
+    int status;             /* wait status of the last command in the line (as filled by waitpid) */
+    struct rusage usage;    /* resources used by the processes the command line started */
+} serverReply;
+
+/* Creates a listening Unix domain socket bound to path (a stale socket there is replaced, any other file is kept) */
+/* Returns the listening fd, or -1 on error (errno is set, EEXIST when path is not a socket) */
+int listenOn(const char *path);
+
+/* Connects to the server listening on path */
+/* Returns the connected fd, or -1 on error (errno is set) */
+int connectTo(const char *path);
+
+/* Sends a command line together with fds[0..SERVER_FDS-1] (stdin, stdout, stderr) */
+/* Returns 0 on success, -1 on error */
+int sendCommand(int sock, const char *commandLine, const int fds[SERVER_FDS]);
+
+/* Receives a command line (null terminated, at most size-1 chars) and the fds sent with it */
+/* Returns 1 on success, 0 when the peer closed the connection, -1 on error */
+int receiveCommand(int sock, char *commandLine, int size, int fds[SERVER_FDS]);
+
+/* Sends / receives the result of a command line */
+/* Both return 0 on success, -1 on error */
+int sendReply(int sock, const serverReply *reply);
+int receiveReply(int sock, serverReply *reply);
@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "TimerWheel.h"
+
+/* One extra slot holds the timers that expired during the current tick */
+#define EXPIRED_SLOT WHEEL_SLOTS
+#define TICK_NS (WHEEL_TICK_MS * 1000000LL)
+
+static timer *slots[WHEEL_SLOTS + 1];
+static int current = 0;
+static int count = 0;
+static int tfd = -1;
+/* ticks that already passed but were not applied to current yet */
+static unsigned long owed = 0;
+
+/* The timerfd only ticks while at least one timer is armed */
+static int armTicks(int on)
+{
+    struct itimerspec spec;
+
+    memset(&spec, 0, sizeof(spec));
+    if (on) {
+        spec.it_value.tv_sec = WHEEL_TICK_MS / 1000;
+        spec.it_value.tv_nsec = (WHEEL_TICK_MS % 1000) * 1000000L;
+        spec.it_interval = spec.it_value;
+    }
+    return timerfd_settime(tfd, 0, &spec, NULL);
+}
+
+static void linkTimer(timer *t, int slot)
+{
+    t->slot = slot;
+    t->prev = NULL;
+    t->next = slots[slot];
+    if (t->next)
+        t->next->prev = t;
+    slots[slot] = t;
+}
+
+static void unlinkTimer(timer *t)
+{
+    if (t->prev)
+        t->prev->next = t->next;
+    else
+        slots[t->slot] = t->next;
+    if (t->next)
+        t->next->prev = t->prev;
+    t->prev = t->next = NULL;
+    t->slot = -1;
+}
+
+void initTimer(timer *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->slot = -1;
+}
+
+/* Nanoseconds until the timerfd's next tick, also collecting the ticks it already reported into owed */
+static long long untilNextTick(void)
+{
+    struct itimerspec left;
+    uint64_t ticks;
+
+    if (read(tfd, &ticks, sizeof(ticks)) == sizeof(ticks))
+        owed += ticks;
+    if (timerfd_gettime(tfd, &left) == -1)
+        return 0;
+    return left.it_value.tv_sec * 1000000000LL + left.it_value.tv_nsec;
+}
+
+int addTimer(timer *t, long ms, timerCallback callback, void *arg)
+{
+    unsigned long ticks, distance;
+    long long leftNs, wantNs = (long long)ms * 1000000LL;
+
+    if (tfd == -1) {
+        tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (tfd == -1)
+            return -1;
+    }
+
+    cancelTimer(t);
+    if (count == 0) {
+        if (armTicks(1) == -1)
+            return -1;
+        owed = 0; /* nothing was waiting on the ticks missed while idle */
+        leftNs = TICK_NS;
+    }
+    else {
+        leftNs = untilNextTick();
+    }
+
+    /* The next tick may be close, so count whole ticks only after it: the timer never fires before ms passed */
+    ticks = wantNs <= leftNs ? 1 : 1 + (unsigned long)((wantNs - leftNs + TICK_NS - 1) / TICK_NS);
+    distance = owed + ticks;
+    t->callback = callback;
+    t->arg = arg;
+    t->rounds = (distance - 1) / WHEEL_SLOTS;
+    linkTimer(t, (current + distance) % WHEEL_SLOTS);
+    count++;
+    return 0;
+}
+
+void cancelTimer(timer *t)
+{
+    if (t->slot == -1)
+        return;
+
+    unlinkTimer(t);
+    if (--count == 0)
+        armTicks(0);
+}
+
+int wheelFd(void)
+{
+    return tfd;
+}
+
+int ticksOwed(void)
+{
+    return owed > 0;
+}
+
+int pendingTimers(void)
+{
+    return count;
+}
+
+void advanceWheel(void)
+{
+    uint64_t ticks;
+    timer *t, *next;
+
+    if (tfd == -1)
+        return;
+    if (read(tfd, &ticks, sizeof(ticks)) == sizeof(ticks))
+        owed += ticks;
+
+    /* owed counts the ticks still to apply, so timers added by callbacks are placed after them */
+    while (owed > 0) {
+        if (count == 0) {
+            owed = 0;
+            break;
+        }
+        owed--;
+        current = (current + 1) % WHEEL_SLOTS;
+
+        for (t = slots[current]; t; t = next) {
+            next = t->next;
+            if (t->rounds > 0) {
+                t->rounds--;
+            }
+            else {
+                unlinkTimer(t);
+                linkTimer(t, EXPIRED_SLOT);
+            }
+        }
+
+        /* Callbacks may add or cancel timers, so they run only after the slot was walked */
+        while ((t = slots[EXPIRED_SLOT])) {
+            cancelTimer(t);
+            t->callback(t->arg);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#define WHEEL_SLOTS 1024
+#define WHEEL_TICK_MS 100
+
+typedef void (*timerCallback)(void *arg);
+
+typedef struct timer
+{
+    unsigned long rounds;       /* full turns of the wheel left before the timer expires */
+    int slot;                   /* slot holding the timer, -1 when it is not armed */
+    timerCallback callback;     /* called once when the timer expires */
+    void *arg;                  /* argument passed to callback */
+    struct timer *prev;         /* neighbours in the slot's list */
+    struct timer *next;
+} timer;
+
+/* Prepares a timer so it can be cancelled before it was ever added */
+void initTimer(timer *t);
+
+/* Arms t to call callback(arg) once ms milliseconds passed (never earlier, at most one tick later) */
+/* An already armed timer is moved to the new deadline */
+/* Returns 0 on success, -1 if the wheel's timerfd could not be created */
+int addTimer(timer *t, long ms, timerCallback callback, void *arg);
+
+/* Disarms t. Does nothing if t is not armed */
+void cancelTimer(timer *t);
+
+/* Returns the timerfd driving the wheel (readable when a tick passed), -1 while no timer was ever added */
+int wheelFd(void);
+
+/* Returns nonzero when ticks were already taken off the timerfd (by addTimer) but not applied yet */
+/* The fd is not readable for those, so call advanceWheel before waiting on it again */
+int ticksOwed(void);
+
+/* Returns the number of armed timers */
+int pendingTimers(void);
+
+/* Consumes the ticks that passed on the timerfd and runs the callbacks of the timers that expired */
+void advanceWheel(void);
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "OutputRing.h"
+
+// Throughput of a job's output captured into an OutputRing against the same job writing to stdout directly
+// Usage: ring_bench [megabytes] [cap-kb] (run it on a terminal to compare with the tty, stdout is written to)
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// The "job": writes megabytes of output to fd and exits
+static pid_t startWriter(int fd, long megabytes) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        static char buf[64 * 1024];
+        memset(buf, 'x', sizeof(buf));
+        buf[sizeof(buf) - 1] = '\n';
+        for (long i = 0; i < megabytes * 16; i++) {
+            if (write(fd, buf, sizeof(buf)) != sizeof(buf)) {
+                _exit(EXIT_FAILURE);
+            }
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    return pid;
+}
+
+int main(int argc, char **argv) {
+    long megabytes = argc > 1 ? atol(argv[1]) : 256;
+    size_t cap = (argc > 2 ? atol(argv[2]) : 64) * 1024;
+    outputRing ring;
+    int writeFd;
+
+    double start = now();
+    if (openRing(&ring, cap, &writeFd) == -1) {
+        perror("openRing");
+        return EXIT_FAILURE;
+    }
+    pid_t pid = startWriter(writeFd, megabytes);
+    close(writeFd);
+    while (ring.readFd != -1) {
+        struct pollfd fd = { ring.readFd, POLLIN, 0 };
+        poll(&fd, 1, -1);
+        drainRing(&ring);
+    }
+    waitpid(pid, NULL, 0);
+    double captured = now() - start;
+    closeRing(&ring);
+
+    start = now();
+    pid = startWriter(STDOUT_FILENO, megabytes);
+    waitpid(pid, NULL, 0);
+    double direct = now() - start;
+
+    fprintf(stderr, "%ld MB: ring (%zu KB cap) %.0f MB/s, direct to stdout %.0f MB/s\n",
+            megabytes, ring.size / 1024, megabytes / captured, megabytes / direct);
+    return EXIT_SUCCESS;
+}
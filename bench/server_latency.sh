@@ -0,0 +1,25 @@
+#!/bin/sh
+# Round trip of one command: a cold "myshell -c" against "myshellc" talking to a warm "myshell --serve"
+# Usage: bench/server_latency.sh [runs] [command]   (after 'make', from the repository root)
+
+RUNS=${1:-1000}
+COMMAND=${2:-/bin/true}
+SOCKET=$(mktemp -u /tmp/myshell-bench.XXXXXX)
+
+now() { date +%s%N; }
+
+# The trailing -d keeps myshell's debug output off
+./myshell --serve "$SOCKET" -d >/dev/null 2>&1 &
+SERVER=$!
+trap 'kill $SERVER 2>/dev/null; rm -f "$SOCKET"' EXIT
+while [ ! -S "$SOCKET" ]; do sleep 0.01; done
+
+start=$(now)
+i=0; while [ $i -lt "$RUNS" ]; do ./myshell -c "$COMMAND" -d >/dev/null; i=$((i + 1)); done
+cold=$(( ($(now) - start) / RUNS / 1000 ))
+
+start=$(now)
+i=0; while [ $i -lt "$RUNS" ]; do ./myshellc "$SOCKET" $COMMAND >/dev/null; i=$((i + 1)); done
+warm=$(( ($(now) - start) / RUNS / 1000 ))
+
+echo "runs $RUNS: myshell -c ${cold} us, myshellc ${warm} us"
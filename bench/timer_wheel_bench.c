@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <time.h>
+#include "TimerWheel.h"
+
+// Add, cancel and expiry cost of the timer wheel with many concurrent deadlines
+// Usage: timer_wheel_bench [timers] (default 10000, deadlines spread over 2 seconds)
+
+static int fired = 0;
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void onExpire(void *arg) {
+    (void)arg;
+    fired++;
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    timer* timers = malloc(sizeof(timer) * count);
+    double addNs, cancelNs, tickNs = 0;
+    int ticks = 0;
+
+    double start = now();
+    for (int i = 0; i < count; i++) {
+        initTimer(&timers[i]);
+        if (addTimer(&timers[i], 100 + (i % 20) * 100, onExpire, NULL) == -1) {
+            perror("addTimer");
+            return EXIT_FAILURE;
+        }
+    }
+    addNs = now() - start;
+
+    // Cancel every other timer, as if half of the jobs finished in time
+    start = now();
+    for (int i = 0; i < count; i += 2) {
+        cancelTimer(&timers[i]);
+    }
+    cancelNs = now() - start;
+
+    while (pendingTimers() > 0) {
+        struct pollfd fd = { wheelFd(), POLLIN, 0 };
+        if (!ticksOwed())
+            poll(&fd, 1, -1);
+        start = now();
+        advanceWheel();
+        tickNs += now() - start;
+        ticks++;
+    }
+
+    printf("timers %d: add %.0f ns, cancel %.0f ns, %d fired over %d ticks, %.1f us per tick\n",
+           count, addNs / count, cancelNs / ((count + 1) / 2), fired, ticks, tickNs / ticks / 1000);
+    free(timers);
+    return EXIT_SUCCESS;
+}
@@ -1,19 +1,34 @@
+#define _GNU_SOURCE // splice, pipe2
 #include <stdio.h> // C standard
 #include <unistd.h> // execv, fork ...
 #include <linux/limits.h> // PATH MAX
+#include <limits.h> // INT_MAX
 #include <stdlib.h> // maloc
 #include <string.h> // strcmp
 #include <sys/types.h> // data types in system call
 #include <sys/wait.h> // waitpd
 #include <errno.h> // errno
 #include <signal.h> //SIG
+#include <fcntl.h> // open, O_CLOEXEC
+#include <sys/socket.h> // accept4
+#include <sys/syscall.h> // SYS_pidfd_open
+#include <poll.h> // poll
 #include "LineParser.h"
 #include <stdbool.h>
 #include <ctype.h>
+#include "ShellServer.h"
+#include "TimerWheel.h"
+#include "OutputRing.h"
 
 #define TERMINATED  -1
 #define RUNNING 1
 #define SUSPENDED 0
+#define TIMEDOUT 2
+#define DEFAULT_GRACE_MS 2000
+#define MAX_DEADLINE_MS INT_MAX // ~24.8 days, still fits a 32 bit long
+#define WAIT_POLL_MS 10
+#define DEFAULT_CAPTURE_CAP (64 * 1024)
+#define MAX_CAPTURE_CAP (256UL * 1024 * 1024)
 #define HISTLEN 20
 #define MAX_BUF 200
 
@@ -25,7 +40,13 @@
 typedef struct process{
         cmdLine* cmd;                         /* the parsed command line*/
         pid_t pid; 		                  /* the process id that is running the command*/
-        int status;                           /* status of the process: RUNNING/SUSPENDED/TERMINATED */
+        int status;                           /* status of the process: RUNNING/SUSPENDED/TERMINATED/TIMEDOUT */
+        timer deadline;                       /* fires at the deadline (SIGTERM), then after the grace period (SIGKILL) */
+        bool termSent;                        /* SIGTERM was sent, the next expiry sends SIGKILL */
+        bool ownGroup;                        /* leads its own process group, so deadlines signal the whole group */
+        outputRing* output;                   /* captured stdout/stderr of a non-blocking job, NULL when not captured */
+        bool reaped;                          /* already waited for, only kept until its captured output is shown */
+        int job;                              /* job number of a captured job (%job in "output"), 0 when not captured */
         struct process *next;	                  /* next process in chain */
 } process;
 
@@ -33,20 +54,52 @@ char history[HISTLEN][MAX_BUF];
 int newest = -1;
 int oldest = 0;
 int history_count = 0;
+int lastStatus = 0; // wait status of the last command executed (for -c and --serve)
+long defaultDeadlineMs = 0; // deadline given to every non-blocking job, 0 for none
+long graceMs = DEFAULT_GRACE_MS; // time between SIGTERM and SIGKILL once a deadline passed
+bool captureOutput = false; // capture the output of non-blocking jobs instead of writing it to the terminal
+size_t captureCap = DEFAULT_CAPTURE_CAP; // bytes of output kept per captured job
+int nextJob = 1; // job number given to the next captured job
+struct pollfd* pollSet = NULL; // reused by pollEvents, grows with the number of captured jobs
+struct process** pollJobs = NULL; // job owning each captured pollSet entry
+int pollCapacity = 0;
 
 int handleCDcommand(cmdLine * pCmdLine , bool debug);
 void handle_signal_commands(cmdLine *pCmdLine , bool debug, process** process_list);
 void handleRedirection(cmdLine * pCmdLine);
+int redirectFd(const char* path, int flags, int targetFd);
+int isFileFeeder(cmdLine * pCmdLine);
+void feedFromFile(const char* path, int outFd);
 void show_history(); 
 char* get_command_from_history(int index); 
 int is_numeric(const char *str);
 int addToHistory(char* command);   
 void clean(char* fileName);
 void addProcess(process** process_list, cmdLine* cmd, pid_t pid);
+void setDeadline(process* proc, long ms);
+void onDeadline(void* arg);
+int parseDuration(const char* str, long* ms);
+int handleTimeout(cmdLine* pCmdLine, long* deadlineMs);
+void handleDeadlineCommand(cmdLine* pCmdLine);
+int growPollSet(int needed);
+void pollEvents(int fd, int timeoutMs, process** process_list);
+int waitForProcess(pid_t pid, int* status, process** process_list);
+void freeProcess(process* proc);
+void removeProcess(process** process_list, process* proc);
+int parseSize(const char* str, size_t* bytes);
+void handleCaptureCommand(cmdLine* pCmdLine);
+void handleOutputCommand(cmdLine* pCmdLine, process** process_list);
+void drainOutputs(process* process_list);
 void printProcessList(process** process_list);
 void freeProcessList(process* process_list);
 void updateProcessStatus(process* process_list, int pid, int status);
 void updateProcessList(process** process_list);
+void execute(cmdLine *pCmdLine, bool debug, process** process_list);
+int runCommandLine(char* input, bool debug, process** process_list);
+int exitCodeOf(int status);
+int serve(const char* socketPath, bool debug);
+void serveClient(int client, bool debug);
+int moveAboveStdio(int fd);
 
 
 void addProcess(process** process_list, cmdLine* cmd, pid_t pid) {
@@ -54,42 +107,374 @@ void addProcess(process** process_list, cmdLine* cmd, pid_t pid) {
     newProcess->cmd = cmd;
     newProcess->pid = pid;
     newProcess->status = RUNNING;
+    initTimer(&newProcess->deadline);
+    newProcess->termSent = false;
+    newProcess->ownGroup = false;
+    newProcess->output = NULL;
+    newProcess->reaped = false;
+    newProcess->job = 0;
     newProcess->next = *process_list;
     *process_list = newProcess;
 }
 
+void setDeadline(process* proc, long ms) {
+    if (ms > 0 && addTimer(&proc->deadline, ms, onDeadline, proc) == -1) {
+        perror("Failed to set deadline");
+    }
+}
+
+void onDeadline(void* arg) {
+    process* proc = arg;
+    // A job in its own group takes whatever it started down with it
+    pid_t target = proc->ownGroup ? -proc->pid : proc->pid;
+    if (!proc->termSent) {
+        // Ask politely first, and come back after the grace period
+        kill(target, SIGTERM);
+        proc->status = TIMEDOUT;
+        proc->termSent = true;
+        if (graceMs > 0) {
+            setDeadline(proc, graceMs);
+            return;
+        }
+        // "deadline <dur> 0" leaves no grace period, so it is killed right away
+    }
+    kill(target, SIGKILL);
+}
+
+int parseDuration(const char* str, long* ms) {
+    // Accepts "1.5", "1.5s", "200ms", "2m" and "1h" (plain numbers are seconds)
+    char* end;
+    double unit;
+    double value = strtod(str, &end);
+    if (end == str || value < 0) {
+        return 0;
+    }
+    if (strcmp(end, "ms") == 0) {
+        unit = 1;
+    }
+    else if (*end == '\0' || strcmp(end, "s") == 0) {
+        unit = 1000;
+    }
+    else if (strcmp(end, "m") == 0) {
+        unit = 60 * 1000;
+    }
+    else if (strcmp(end, "h") == 0) {
+        unit = 60 * 60 * 1000;
+    }
+    else {
+        return 0;
+    }
+    // Checked before the cast, and written so that nan fails it too
+    if (!(value * unit <= MAX_DEADLINE_MS)) {
+        return 0;
+    }
+    *ms = (long)(value * unit);
+    return 1;
+}
+
+int handleTimeout(cmdLine* pCmdLine, long* deadlineMs) {
+    // "timeout <dur> cmd ..." runs "cmd ..." (and the rest of its pipeline) with a deadline
+    if (pCmdLine->argCount < 3 || !parseDuration(pCmdLine->arguments[1], deadlineMs)) {
+        fprintf(stderr, "Usage: timeout <duration> <command> (duration up to %dms)\n", MAX_DEADLINE_MS);
+        return 1;
+    }
+    char** arguments = (char**)pCmdLine->arguments;
+    free(arguments[0]);
+    free(arguments[1]);
+    memmove(arguments, arguments + 2, (pCmdLine->argCount - 2) * sizeof(char*));
+    pCmdLine->argCount -= 2;
+    arguments[pCmdLine->argCount] = NULL;
+    arguments[pCmdLine->argCount + 1] = NULL;
+    return 0;
+}
+
+void handleDeadlineCommand(cmdLine* pCmdLine) {
+    // "deadline" shows, "deadline <dur> [grace]" sets and "deadline off" clears the default for jobs run with &
+    if (pCmdLine->argCount == 1) {
+        printf("deadline %ldms, grace %ldms\n", defaultDeadlineMs, graceMs);
+        return;
+    }
+    long deadline, grace = graceMs;
+    if (strcmp(pCmdLine->arguments[1], "off") == 0) {
+        defaultDeadlineMs = 0;
+        return;
+    }
+    if (pCmdLine->argCount > 3 || !parseDuration(pCmdLine->arguments[1], &deadline) ||
+        (pCmdLine->argCount == 3 && !parseDuration(pCmdLine->arguments[2], &grace))) {
+        fprintf(stderr, "Usage: deadline [<duration> [grace] | off] (durations up to %dms)\n", MAX_DEADLINE_MS);
+        return;
+    }
+    defaultDeadlineMs = deadline;
+    graceMs = grace;
+}
+
+int parseSize(const char* str, size_t* bytes) {
+    // Accepts "4096", "64k" and "1m", up to MAX_CAPTURE_CAP
+    char* end;
+    unsigned long unit = 1;
+    if (!isdigit((unsigned char)str[0])) {
+        return 0;
+    }
+    errno = 0;
+    unsigned long value = strtoul(str, &end, 10);
+    if (value == 0 || errno == ERANGE) {
+        return 0;
+    }
+    if (*end == 'k' || *end == 'K') {
+        unit = 1024;
+        end++;
+    }
+    else if (*end == 'm' || *end == 'M') {
+        unit = 1024 * 1024;
+        end++;
+    }
+    // Checked before multiplying, unsigned long is only 32 bits with -m32
+    if (*end != '\0' || value > MAX_CAPTURE_CAP / unit) {
+        return 0;
+    }
+    *bytes = value * unit;
+    return 1;
+}
+
+void handleCaptureCommand(cmdLine* pCmdLine) {
+    // "capture" shows, "capture on [cap]" and "capture off" switch output capture for jobs run with &
+    if (pCmdLine->argCount == 1) {
+        printf("capture %s, %zu bytes per job\n", captureOutput ? "on" : "off", captureCap);
+    }
+    else if (strcmp(pCmdLine->arguments[1], "off") == 0 && pCmdLine->argCount == 2) {
+        captureOutput = false;
+    }
+    else if (strcmp(pCmdLine->arguments[1], "on") == 0 && pCmdLine->argCount <= 3 &&
+             (pCmdLine->argCount == 2 || parseSize(pCmdLine->arguments[2], &captureCap))) {
+        captureOutput = true;
+    }
+    else {
+        fprintf(stderr, "Usage: capture [on [cap] | off] (cap up to %lum)\n", MAX_CAPTURE_CAP / (1024 * 1024));
+    }
+}
+
+void handleOutputCommand(cmdLine* pCmdLine, process** process_list) {
+    if (pCmdLine->argCount == 2 && strcmp(pCmdLine->arguments[1], "clear") == 0) {
+        // Drop the output of every finished job without showing it
+        process* current = *process_list;
+        while (current != NULL) {
+            process* next = current->next;
+            if (current->reaped) {
+                removeProcess(process_list, current);
+            }
+            current = next;
+        }
+        return;
+    }
+    // The job is named by its process id or by its job number as "%N"
+    const char* name = pCmdLine->argCount == 2 ? pCmdLine->arguments[1] : "";
+    bool byJob = name[0] == '%';
+    if (pCmdLine->argCount != 2 || !is_numeric(name + byJob) || name[byJob] == '\0') {
+        fprintf(stderr, "Usage: output <process id | %%job> | output clear\n");
+        return;
+    }
+    int id = atoi(name + byJob);
+    process* current = *process_list;
+    while (current != NULL && (byJob ? current->job : current->pid) != id) {
+        current = current->next;
+    }
+    if (current == NULL || current->output == NULL) {
+        fprintf(stderr, "No captured output for %s\n", name);
+        return;
+    }
+    drainRing(current->output);
+    fflush(stdout);
+    writeRing(current->output, STDOUT_FILENO);
+    if (current->reaped) {
+        removeProcess(process_list, current); // Shown once the job is over, nothing left to keep it for
+    }
+}
+
+void drainOutputs(process* process_list) {
+    for (process* current = process_list; current != NULL; current = current->next) {
+        if (current->output != NULL) {
+            drainRing(current->output);
+        }
+    }
+}
+
+int growPollSet(int needed) {
+    if (needed <= pollCapacity) {
+        return 1;
+    }
+    int capacity = pollCapacity > 0 ? pollCapacity : 64;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    struct pollfd* fds = realloc(pollSet, capacity * sizeof(struct pollfd));
+    if (fds == NULL) {
+        return 0;
+    }
+    pollSet = fds;
+    process** jobs = realloc(pollJobs, capacity * sizeof(process*));
+    if (jobs == NULL) {
+        return 0;
+    }
+    pollJobs = jobs;
+    pollCapacity = capacity;
+    return 1;
+}
+
+void pollEvents(int fd, int timeoutMs, process** process_list) {
+    // Waits until fd is readable (or timeoutMs passed, -1 for no limit),
+    // expiring deadlines and draining captured job output in the meantime
+    while (1) {
+        if (ticksOwed()) {
+            advanceWheel(); // addTimer took these ticks off the timerfd, poll would not report them
+        }
+        // Slots 0 and 1 are fd and the wheel, the captured jobs follow
+        int count = 2;
+        if (!growPollSet(count)) {
+            perror("poll set");
+            return;
+        }
+        for (process* current = *process_list; current != NULL; current = current->next) {
+            if (current->output != NULL && current->output->readFd != -1) {
+                if (!growPollSet(count + 1)) {
+                    perror("poll set");
+                    return;
+                }
+                pollSet[count].fd = current->output->readFd;
+                pollSet[count].events = POLLIN;
+                pollJobs[count++] = current;
+            }
+        }
+        int wheel = pendingTimers() > 0 ? wheelFd() : -1; // poll skips negative fds
+        if (wheel == -1 && count == 2 && fd == STDIN_FILENO) {
+            return; // Nothing to do but read the input
+        }
+        pollSet[0].fd = fd;
+        pollSet[0].events = POLLIN;
+        pollSet[1].fd = wheel;
+        pollSet[1].events = POLLIN;
+
+        int polled = poll(pollSet, count, timeoutMs);
+        if (polled <= 0) {
+            if (polled == -1 && errno == EINTR) {
+                continue;
+            }
+            if (polled == -1) {
+                perror("poll");
+            }
+            return;
+        }
+        if (pollSet[1].revents & POLLIN) {
+            advanceWheel();
+        }
+        for (int i = 2; i < count; i++) {
+            if (pollSet[i].revents) {
+                drainRing(pollJobs[i]->output);
+            }
+        }
+        if (pollSet[0].revents) {
+            return;
+        }
+    }
+}
+
+int waitForProcess(pid_t pid, int* status, process** process_list) {
+#ifdef SYS_pidfd_open
+    // A pidfd becomes readable when the process exits, so it can be polled together with the timers
+    int pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd != -1) {
+        pollEvents(pidfd, -1, process_list);
+        close(pidfd);
+        return waitpid(pid, status, 0);
+    }
+#endif
+    // No pidfds (old kernel or seccomp): check on the process between short polls, so deadlines are still enforced
+    pid_t result;
+    while ((result = waitpid(pid, status, WNOHANG)) == 0) {
+        pollEvents(-1, WAIT_POLL_MS, process_list);
+    }
+    return result;
+}
+
 void printProcessList(process** process_list) {
-    printf("PID\tCommand\t\tSTATUS\n");
+    drainOutputs(*process_list);
+    printf("PID\tCommand\t\tSTATUS\t\tOUTPUT\n");
     process* current = *process_list;
     while (current != NULL) {
-        printf("%d\t%s\t%s\n", current->pid, current->cmd->arguments[0], 
+        char bytes[32] = "-";
+        if (current->output != NULL) {
+            snprintf(bytes, sizeof(bytes), "%%%d %llu bytes", current->job, current->output->total);
+        }
+        printf("%d\t%s\t%s\t%s\n", current->pid, current->cmd->arguments[0], 
                (current->status == TERMINATED ? "Terminated" : 
-                current->status == RUNNING ? "Running" : "Suspended"));
+                current->status == TIMEDOUT ? "Timed out" :
+                current->status == RUNNING ? "Running" : "Suspended"), bytes);
         current = current->next;
     }
 }
 
+void freeProcess(process* proc) {
+    cancelTimer(&proc->deadline);
+    if (proc->output != NULL) {
+        closeRing(proc->output);
+        free(proc->output);
+    }
+    freeCmdLines(proc->cmd);
+    free(proc);
+}
+
+void removeProcess(process** process_list, process* proc) {
+    process** link = process_list;
+    while (*link != NULL && *link != proc) {
+        link = &(*link)->next;
+    }
+    if (*link == proc) {
+        *link = proc->next;
+        freeProcess(proc);
+    }
+}
+
 void freeProcessList(process* process_list) {
     process* current = process_list;
     while (current != NULL) {
         process *temp = current;
         current = current->next;
-        freeCmdLines(temp->cmd);
-        free(temp);
+        freeProcess(temp);
     }
 }
 
 void updateProcessList(process** process_list) {
     process *current = *process_list;
     process *prev = NULL;
-    int status;
+    int status = 0;
 
     while (current != NULL) {
+        if (current->reaped) {
+            // Waited for already, the entry only holds captured output
+            prev = current;
+            current = current->next;
+            continue;
+        }
         pid_t result = waitpid(current->pid, &status, WNOHANG);
-        if (result != 0 || WIFEXITED(status)) {
+        // 0 means it still runs, ECHILD that it was already waited for (e.g. by waitForProcess)
+        bool finished = result == current->pid || (result == -1 && errno == ECHILD);
+        if (finished && current->output != NULL) {
+            // Keep the captured output until "output" shows it or "output clear" drops it
+            printf("PID %d: %s %s\n", current->pid, current->cmd->arguments[0],
+                   current->status == TIMEDOUT ? "Timed out" : "Terminated");
+            if (current->status != TIMEDOUT) {
+                current->status = TERMINATED;
+            }
+            current->reaped = true;
+            cancelTimer(&current->deadline);
+            drainRing(current->output);
+            prev = current;
+            current = current->next;
+        }
+        else if (finished) {
             // Process is terminated
+            printf("PID %d: %s %s\n", current->pid, current->cmd->arguments[0],
+                   current->status == TIMEDOUT ? "Timed out" : "Terminated");
             current->status = TERMINATED;
-            printf("PID %d: %s Terminated\n", current->pid, current->cmd->arguments[0]);
             process *to_free = current;
             if (prev == NULL) {
                 *process_list = current->next;
@@ -98,8 +483,7 @@ void updateProcessList(process** process_list) {
                 prev->next = current->next;
                 current = current->next;
             }
-            freeCmdLines(to_free->cmd);
-            free(to_free);
+            freeProcess(to_free);
         } 
         else {
             // Process is still running or suspended
@@ -113,6 +497,12 @@ void updateProcessStatus(process* process_list, int pid, int status) {
     process *current = process_list;
     while (current != NULL) {
         if (current->pid == pid) {
+            if (status == TERMINATED) {
+                cancelTimer(&current->deadline);
+                if (current->status == TIMEDOUT) {
+                    break; // Keep the reason it terminated
+                }
+            }
             current->status = status;
             break;
         }
@@ -152,17 +542,86 @@ int is_numeric(const char *str) {
     return 1; // All characters are digits
 }
 
+int redirectFd(const char* path, int flags, int targetFd){
+    // O_CLOEXEC so the descriptor never survives into the exec'd program
+    int fd = open(path, flags | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return -1;
+    }
+    if (fd != targetFd) {
+        if (dup2(fd, targetFd) == -1) {
+            close(fd);
+            return -1;
+        }
+        close(fd);
+    }
+    return 0;
+}
+
 void handleRedirection(cmdLine * pCmdLine){
-    if (!freopen(pCmdLine->inputRedirect, "r", stdin)) { //handling input redirectoin
-        perror("Failed to redirect stdin");
-        exit(1);
+    static const char* streams[] = { "stdin", "stdout", "stderr" };
+    char message[64];
+
+    // Applied in the order they were written, so "2>&1 >f" keeps stderr on the old stdout like sh does
+    for (int i = 0; i < pCmdLine->redirectCount; i++) {
+        const redirection* r = &pCmdLine->redirects[i];
+        int result;
+        if (r->path == NULL && r->dupFd == -1) {
+            errno = EBADF; // ">&word" never names a file
+            result = -1;
+        }
+        else if (r->path == NULL) {
+            result = dup2(r->dupFd, r->fd); // N>&M (also the second half of &>)
+        }
+        else if (r->fd == STDIN_FILENO) {
+            result = redirectFd(r->path, O_RDONLY, r->fd);
+        }
+        else {
+            result = redirectFd(r->path, O_WRONLY | O_CREAT | (r->append ? O_APPEND : O_TRUNC), r->fd);
+        }
+        if (result == -1) {
+            if (r->fd <= STDERR_FILENO)
+                snprintf(message, sizeof(message), "Failed to redirect %s", streams[r->fd]);
+            else
+                snprintf(message, sizeof(message), "Failed to redirect fd %d", r->fd);
+            perror(message);
+            _exit(1);
+        }
     }
+}
+
+int isFileFeeder(cmdLine * pCmdLine){
+    // "cat <file>" with no options or redirections only copies the file into the pipe
+    return strcmp(pCmdLine->arguments[0], "cat") == 0 && pCmdLine->argCount == 2 &&
+           pCmdLine->arguments[1][0] != '-' && pCmdLine->redirectCount == 0;
+}
+
+void feedFromFile(const char* path, int outFd){
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        fprintf(stderr, "cat: %s: %s\n", path, strerror(errno));
+        _exit(1);
+    }
+
+    // Move the file into the pipe inside the kernel instead of exec'ing cat
+    ssize_t moved;
+    while ((moved = splice(fd, NULL, outFd, NULL, 1 << 16, SPLICE_F_MOVE)) > 0);
 
-    // Redirect stdout to output.txt
-    if (!freopen(pCmdLine->outputRedirect, "w", stdout)) { //handling output redirectoin
-        perror("Failed to redirect stdout");
-        exit(1);
-    }  
+    if (moved == -1 && (errno == EINVAL || errno == ENOSYS)) {
+        // splice is not supported for this file, copy it the regular way
+        char buf[1 << 16];
+        while ((moved = read(fd, buf, sizeof(buf))) > 0) {
+            if (write(outFd, buf, moved) != moved) {
+                moved = -1;
+                break;
+            }
+        }
+    }
+    if (moved == -1 && errno != EPIPE) {
+        fprintf(stderr, "cat: %s: %s\n", path, strerror(errno)); // e.g. a directory
+    }
+    close(fd);
+    _exit(moved == -1 ? 1 : 0);
 }
 
 void handle_signal_commands(cmdLine *pCmdLine , bool debug, process** process_list) {
@@ -262,6 +721,12 @@ void clean(char* fileName){
 }
 
 void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
+    lastStatus = 0;
+    long deadlineMs = 0;
+    if (strcmp(pCmdLine->arguments[0], "timeout") == 0 && handleTimeout(pCmdLine, &deadlineMs) == 1) {
+        return;
+    }
+
     // Handle built-in commands and special cases first
     if (handleCDcommand(pCmdLine, debug) == 1) {
         return;
@@ -296,6 +761,18 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
         updateProcessList(process_list);
         return;
     }
+    else if (strcmp(pCmdLine->arguments[0], "capture") == 0) {
+        handleCaptureCommand(pCmdLine);
+        return;
+    }
+    else if (strcmp(pCmdLine->arguments[0], "output") == 0) {
+        handleOutputCommand(pCmdLine, process_list);
+        return;
+    }
+    else if (strcmp(pCmdLine->arguments[0], "deadline") == 0) {
+        handleDeadlineCommand(pCmdLine);
+        return;
+    }
     else if (strcmp(pCmdLine->arguments[0], "alarm") == 0 || 
             strcmp(pCmdLine->arguments[0], "blast") == 0 || 
             strcmp(pCmdLine->arguments[0], "sleep") == 0) {
@@ -310,7 +787,7 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
         int pipefd[2];
         
         // Create a pipe
-        if (pipe(pipefd) == -1) {
+        if (pipe2(pipefd, O_CLOEXEC) == -1) {
             perror("pipe");
             exit(EXIT_FAILURE);
         }
@@ -323,9 +800,12 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
         } else if (pid1 == 0) {
             // Child process for the first command (left-hand side)
             close(pipefd[0]); // Close unused read end of the pipe
-            handleRedirection(pCmdLine); // Handle I/O redirection for the first command
+            if (isFileFeeder(pCmdLine)) {
+                feedFromFile(pCmdLine->arguments[1], pipefd[1]); // Fill the pipe without running cat
+            }
             dup2(pipefd[1], STDOUT_FILENO); // Redirect stdout to the write end of the pipe
             close(pipefd[1]); // Close the write end of the pipe
+            handleRedirection(pCmdLine); // Handle I/O redirection for the first command (overrides the pipe)
             execvp(pCmdLine->arguments[0], pCmdLine->arguments); // Execute the first command
             perror("execvp"); // Print error if execvp fails
             _exit(EXIT_FAILURE); // Terminate the child process
@@ -339,29 +819,52 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
         } else if (pid2 == 0) {
             // Child process for the second command (right-hand side)
             close(pipefd[1]); // Close unused write end of the pipe
-            handleRedirection(pCmdLine->next); // Handle I/O redirection for the second command
             dup2(pipefd[0], STDIN_FILENO); // Redirect stdin to the read end of the pipe
             close(pipefd[0]); // Close the read end of the pipe
+            handleRedirection(pCmdLine->next); // Handle I/O redirection for the second command (overrides the pipe)
             execvp(pCmdLine->next->arguments[0], pCmdLine->next->arguments); // Execute the second command
             perror("execvp"); // Print error if execvp fails
             _exit(EXIT_FAILURE); // Terminate the child process
         }
+        if (deadlineMs == 0 && pCmdLine->next->blocking == 0) {
+            deadlineMs = defaultDeadlineMs;
+        }
         addProcess(process_list, pCmdLine, pid1);
+        setDeadline(*process_list, deadlineMs);
         addProcess(process_list, pCmdLine, pid2);
+        setDeadline(*process_list, deadlineMs);
 
         // Close both ends of the pipe in the parent process
         close(pipefd[0]);
         close(pipefd[1]);
 
         // Wait for both child processes to complete
-        waitpid(pid1, NULL, 0);
+        waitForProcess(pid1, NULL, process_list);
         updateProcessStatus(*process_list, pid1, TERMINATED);
-        waitpid(pid2, NULL, 0);
+        waitForProcess(pid2, &lastStatus, process_list); // The pipeline's status is the status of its last command
         updateProcessStatus(*process_list, pid2, TERMINATED);
 
     } 
     else {
         // Execute a single command (no pipeline)
+        outputRing* output = NULL;
+        int outputFd = -1;
+        if (captureOutput && pCmdLine->blocking == 0) {
+            output = malloc(sizeof(outputRing));
+            if (openRing(output, captureCap, &outputFd) == -1) {
+                perror("Failed to capture output");
+                free(output);
+                output = NULL;
+            }
+        }
+
+        if (deadlineMs == 0 && pCmdLine->blocking == 0) {
+            deadlineMs = defaultDeadlineMs;
+        }
+        // A background job with a deadline gets its own process group, so its children are killed too.
+        // Blocking commands stay in the shell's group to keep reading the terminal, only they are signalled
+        bool ownGroup = deadlineMs > 0 && pCmdLine->blocking == 0;
+
         pid_t pid = fork();
         if (pid == -1) {
             perror("fork");
@@ -369,7 +872,15 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
         }
         else if (pid == 0) {
             // Child process
-            handleRedirection(pCmdLine); // Handle I/O redirection for the command
+            if (ownGroup) {
+                setpgid(0, 0);
+            }
+            if (outputFd != -1) {
+                // stdout and stderr go to the job's ring instead of the terminal
+                dup2(outputFd, STDOUT_FILENO);
+                dup2(outputFd, STDERR_FILENO);
+            }
+            handleRedirection(pCmdLine); // Handle I/O redirection for the command (overrides the capture)
             execvp(pCmdLine->arguments[0], pCmdLine->arguments); // Execute the command
             perror("execvp"); // Print error if execvp fails
             _exit(EXIT_FAILURE); // Terminate the child process
@@ -381,9 +892,20 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
                 fprintf(stderr, "Executing command: %s\n", pCmdLine->arguments[0]);
             }
             addProcess(process_list, pCmdLine, pid);
+            if (ownGroup) {
+                setpgid(pid, pid); // Also here, so the group exists before any deadline can fire
+                (*process_list)->ownGroup = true;
+            }
+            if (output != NULL) {
+                close(outputFd); // Only the job writes to the ring
+                (*process_list)->output = output;
+                (*process_list)->job = nextJob++;
+                printf("[%d] %d\n", (*process_list)->job, pid);
+            }
+            setDeadline(*process_list, deadlineMs);
             if (pCmdLine->blocking == 1) {
                 // Wait for the child process to complete if blocking is enabled
-                waitpid(pid, NULL, 0);
+                waitForProcess(pid, &lastStatus, process_list);
                 updateProcessStatus(*process_list, pid, TERMINATED);
             }
         }
@@ -391,17 +913,146 @@ void execute(cmdLine *pCmdLine, bool debug, process** process_list) {
 }
 
 
+int runCommandLine(char* input, bool debug, process** process_list){
+    cmdLine* command = parseCmdLines(input); //parses the input into a cmdLine structure
+    if (command == NULL) {
+        lastStatus = 0; // Nothing to run
+        return 0;
+    }
+    addToHistory(input);
+    execute(command , debug, process_list); //fork a new process and execute the command
+    return 1;
+}
+
+int exitCodeOf(int status){
+    // Same convention as sh: 128 + signal number for killed commands
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
+
+int moveAboveStdio(int fd){
+    if (fd > STDERR_FILENO) {
+        return fd;
+    }
+    int moved = fcntl(fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+    close(fd);
+    return moved;
+}
+
+void serveClient(int client, bool debug){
+    process* process_list_head = NULL;
+    char input[SERVER_MAX_COMMAND];
+    int fds[SERVER_FDS];
+    serverReply reply;
+
+    if (receiveCommand(client, input, sizeof(input), fds) != 1) {
+        if(debug)
+            {perror("receive command");}
+        _exit(1);
+    }
+
+    // A server started with its stdio closed can get 0, 1 or 2 for the client socket or the received fds,
+    // so move them all above 2 before any of them is dup'ed onto the standard descriptors
+    client = moveAboveStdio(client);
+    for (int i = 0; i < SERVER_FDS; i++) {
+        fds[i] = moveAboveStdio(fds[i]);
+        if (client == -1 || fds[i] == -1) {
+            _exit(1);
+        }
+    }
+
+    // The command runs on the client's stdin, stdout and stderr
+    for (int i = 0; i < SERVER_FDS; i++) {
+        dup2(fds[i], i);
+        close(fds[i]);
+    }
+
+    runCommandLine(input, debug, &process_list_head);
+    fflush(stdout);
+    fflush(stderr);
+
+    memset(&reply, 0, sizeof(reply));
+    reply.status = lastStatus;
+    getrusage(RUSAGE_CHILDREN, &reply.usage); // Only this command's children were waited for in this worker
+    if (sendReply(client, &reply) == -1 && debug) {
+        perror("send reply");
+    }
+    _exit(0);
+}
+
+int serve(const char* socketPath, bool debug){
+    int listenFd = listenOn(socketPath);
+    if (listenFd == -1) {
+        perror("Failed to listen");
+        return 1;
+    }
+    if(debug)
+        {fprintf(stderr, "Serving on %s\n", socketPath);}
+
+    // Workers are never waited for, let the kernel reap them
+    signal(SIGCHLD, SIG_IGN);
+    while (1) {
+        int client = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+        if (client == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            perror("accept");
+            break;
+        }
+
+        // Each client gets a forked copy of the warm shell, so a slow command never blocks the others
+        fflush(stdout);
+        pid_t worker = fork();
+        if (worker == 0) {
+            signal(SIGCHLD, SIG_DFL); // execute() waits for its own children
+            close(listenFd);
+            serveClient(client, debug);
+        }
+        else if (worker == -1) {
+            perror("fork");
+        }
+        close(client);
+    }
+    close(listenFd);
+    return 1;
+}
+
 int main(int argc, char **argv){
     process* process_list_head = NULL;
     process** process_list = &process_list_head;
     bool debug = false;
     char cwd[PATH_MAX];
     char input[MAX_INPUT];
+    char* oneCommand = NULL;
+    char* socketPath = NULL;
     if(strcmp(argv[argc-1] , "-d"))
     {
         debug = true;
     }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            oneCommand = argv[++i];
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+    }
     clean("shellHistory");
+    if (socketPath != NULL) {
+        return serve(socketPath, debug);
+    }
+    if (oneCommand != NULL) {
+        // Run a single command line and exit with its status
+        strncpy(input, oneCommand, sizeof(input) - 1);
+        input[sizeof(input) - 1] = '\0';
+        runCommandLine(input, debug, process_list);
+        return exitCodeOf(lastStatus);
+    }
+    // Read the input unbuffered, so polling stdin never misses a line already sitting in stdio's buffer
+    setvbuf(stdin, NULL, _IONBF, 0);
     while(1){
         if (getcwd(cwd, sizeof(cwd)) != NULL) 
         {
@@ -413,6 +1064,8 @@ int main(int argc, char **argv){
                 {perror("getcwd() error");}
         }
         printf("Enter input here:\n");
+        fflush(stdout);
+        pollEvents(STDIN_FILENO, -1, process_list); // Background jobs keep being served while waiting for input
         if (fgets(input, sizeof(input), stdin) != NULL) 
         {
             printf("You entered: %s", input);
@@ -427,9 +1080,7 @@ int main(int argc, char **argv){
         {
             break;
         }
-        cmdLine* command = parseCmdLines(input); //parses the input into a cmdLine structure    
-        addToHistory(input);
-        execute(command , debug, process_list); //fork a new process and execute the command   
+        runCommandLine(input, debug, process_list);
     }
     freeProcessList(*process_list);
     return 0;
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ShellServer.h"
+
+// Runs one command line on a warm "myshell --serve <socket-path>" and exits with its status
+int main(int argc, char **argv) {
+    char commandLine[SERVER_MAX_COMMAND];
+    int fds[SERVER_FDS] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    serverReply reply;
+    int showUsage = 0;
+    int first = 2;
+    size_t len = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        showUsage = 1; // Print the rusage of the command to stderr
+        argv++;
+        argc--;
+    }
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s [-r] <socket-path> <command...>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Join the arguments back into a single line, like the one fgets gives the shell
+    commandLine[0] = '\0';
+    for (int i = first; i < argc; i++) {
+        size_t argLen = strlen(argv[i]);
+        if (len + argLen + 2 >= sizeof(commandLine)) {
+            fprintf(stderr, "Command line too long\n");
+            return EXIT_FAILURE;
+        }
+        memcpy(commandLine + len, argv[i], argLen);
+        len += argLen;
+        commandLine[len++] = (i == argc - 1) ? '\n' : ' ';
+        commandLine[len] = '\0';
+    }
+
+    int sock = connectTo(argv[1]);
+    if (sock == -1) {
+        perror("connect");
+        return EXIT_FAILURE;
+    }
+    if (sendCommand(sock, commandLine, fds) == -1) {
+        perror("send command");
+        return EXIT_FAILURE;
+    }
+    if (receiveReply(sock, &reply) == -1) {
+        perror("receive reply");
+        return EXIT_FAILURE;
+    }
+    close(sock);
+
+    if (showUsage) {
+        fprintf(stderr, "user %ld.%06lds sys %ld.%06lds maxrss %ldKB\n",
+                (long)reply.usage.ru_utime.tv_sec, (long)reply.usage.ru_utime.tv_usec,
+                (long)reply.usage.ru_stime.tv_sec, (long)reply.usage.ru_stime.tv_usec,
+                reply.usage.ru_maxrss);
+    }
+
+    // Same convention as sh: 128 + signal number for killed commands
+    if (WIFSIGNALED(reply.status)) {
+        return 128 + WTERMSIG(reply.status);
+    }
+    return WEXITSTATUS(reply.status);
+}